@@ -1,2 +1,2 @@
 #!/bin/bash
-g++ draw_mapseed.cpp -o draw_mapseed -lGL -lGLEW -lglut -lX11 -lXext -lXrender -lGLU
+g++ -mpopcnt draw_mapseed.cpp -o draw_mapseed -lGL -lGLEW -lglut -lX11 -lXext -lXrender -lGLU -pthread
@@ -0,0 +1,295 @@
+// collision_grid.h
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+// Packed walkability grid built once from the map server's run-length rows.
+//
+// Every row is padded to a whole number of 64-bit words so rows start word
+// aligned and can be scanned a word at a time with popcount / count-trailing-
+// zeros instead of re-walking the run lengths. A set bit means walkable.
+// Connected regions (4-connected) are labelled per run at build time.
+class CollisionGrid {
+public:
+    struct Point {
+        int x = -1;
+        int y = -1;
+    };
+
+    // Build from the "map" rows: runs alternate wall, walkable, wall, ...
+    // starting with a wall run (same convention renderScene draws with).
+    void build(const std::vector<std::vector<int>>& rows) {
+        height_ = static_cast<int>(rows.size());
+        width_ = 0;
+        for (const auto& row : rows) {
+            int sum = 0;
+            for (int val : row) {
+                sum += val;
+            }
+            width_ = std::max(width_, sum);
+        }
+        words_per_row_ = (width_ + 63) / 64;
+        bits_.assign(static_cast<size_t>(words_per_row_) * height_, 0);
+
+        for (int y = 0; y < height_; ++y) {
+            int x = 0;
+            bool wall = true;
+            for (int len : rows[y]) {
+                if (!wall && len > 0) {
+                    set_range(y, x, x + len);
+                }
+                x += len;
+                wall = !wall;
+            }
+        }
+
+        walkable_count_ = 0;
+        for (uint64_t word : bits_) {
+            walkable_count_ += __builtin_popcountll(word);
+        }
+
+        label_regions();
+    }
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+    size_t walkable_count() const { return walkable_count_; }
+    int region_count() const { return region_count_; }
+
+    bool in_bounds(int x, int y) const {
+        return x >= 0 && y >= 0 && x < width_ && y < height_;
+    }
+
+    bool walkable(int x, int y) const {
+        if (!in_bounds(x, y)) {
+            return false;
+        }
+        return (row(y)[x >> 6] >> (x & 63)) & 1;
+    }
+
+    // Region label of (x, y), or -1 for walls / out of bounds.
+    int region_at(int x, int y) const {
+        if (!in_bounds(x, y)) {
+            return -1;
+        }
+        auto first = runs_.begin() + run_offsets_[y];
+        auto last = runs_.begin() + run_offsets_[y + 1];
+        auto it = std::upper_bound(first, last, x,
+                                   [](int px, const Run& r) { return px < r.x1; });
+        if (it == last || x < it->x0) {
+            return -1;
+        }
+        return it->label;
+    }
+
+    // Nearest walkable tile to (x, y) by Euclidean distance, or {-1, -1} if
+    // the grid has none. (x, y) may lie outside the grid.
+    Point nearest_walkable(int x, int y) const {
+        Point best;
+        long long best_d2 = -1;
+        for (int dy = 0; dy <= height_ + std::abs(y); ++dy) {
+            long long dy2 = static_cast<long long>(dy) * dy;
+            if (best_d2 >= 0 && dy2 >= best_d2) {
+                break;
+            }
+            // Row y itself is only scanned once
+            for (int i = 0; i < (dy == 0 ? 1 : 2); ++i) {
+                int ry = i == 0 ? y - dy : y + dy;
+                if (ry < 0 || ry >= height_) {
+                    continue;
+                }
+                int rx = nearest_in_row(ry, x);
+                if (rx < 0) {
+                    continue;
+                }
+                long long dx = rx - x;
+                long long d2 = dx * dx + dy2;
+                if (best_d2 < 0 || d2 < best_d2) {
+                    best_d2 = d2;
+                    best = { rx, ry };
+                }
+            }
+        }
+        return best;
+    }
+
+    // First walkable x >= x in row y, or -1.
+    int next_walkable(int y, int x) const {
+        if (y < 0 || y >= height_ || x >= width_) {
+            return -1;
+        }
+        x = std::max(x, 0);
+        const uint64_t* r = row(y);
+        int w = x >> 6;
+        uint64_t word = r[w] & (~0ULL << (x & 63));
+        while (true) {
+            if (word) {
+                return (w << 6) + __builtin_ctzll(word);
+            }
+            if (++w >= words_per_row_) {
+                return -1;
+            }
+            word = r[w];
+        }
+    }
+
+    // Last walkable x <= x in row y, or -1.
+    int prev_walkable(int y, int x) const {
+        if (y < 0 || y >= height_ || x < 0 || width_ == 0) {
+            return -1;
+        }
+        x = std::min(x, width_ - 1);
+        const uint64_t* r = row(y);
+        int w = x >> 6;
+        uint64_t word = r[w] & (~0ULL >> (63 - (x & 63)));
+        while (true) {
+            if (word) {
+                return (w << 6) + 63 - __builtin_clzll(word);
+            }
+            if (--w < 0) {
+                return -1;
+            }
+            word = r[w];
+        }
+    }
+
+    const uint64_t* row(int y) const {
+        return bits_.data() + static_cast<size_t>(y) * words_per_row_;
+    }
+
+private:
+    struct Run {
+        int x0;     // first walkable x
+        int x1;     // one past the last walkable x
+        int label;
+    };
+
+    void set_range(int y, int x0, int x1) {
+        x1 = std::min(x1, width_);
+        if (x0 >= x1) {
+            return;
+        }
+        uint64_t* r = bits_.data() + static_cast<size_t>(y) * words_per_row_;
+        int w0 = x0 >> 6;
+        int w1 = (x1 - 1) >> 6;
+        uint64_t head = ~0ULL << (x0 & 63);
+        uint64_t tail = ~0ULL >> (63 - ((x1 - 1) & 63));
+        if (w0 == w1) {
+            r[w0] |= head & tail;
+            return;
+        }
+        r[w0] |= head;
+        for (int w = w0 + 1; w < w1; ++w) {
+            r[w] = ~0ULL;
+        }
+        r[w1] |= tail;
+    }
+
+    int nearest_in_row(int y, int x) const {
+        if (x < 0) {
+            return next_walkable(y, 0);
+        }
+        if (x >= width_) {
+            return prev_walkable(y, width_ - 1);
+        }
+        int right = next_walkable(y, x);
+        if (right == x) {
+            return x;
+        }
+        int left = prev_walkable(y, x);
+        if (left < 0) {
+            return right;
+        }
+        if (right < 0) {
+            return left;
+        }
+        return (x - left <= right - x) ? left : right;
+    }
+
+    int find(std::vector<int>& parent, int i) {
+        while (parent[i] != i) {
+            parent[i] = parent[parent[i]];
+            i = parent[i];
+        }
+        return i;
+    }
+
+    // Two-pass run-based labelling: extract runs from the bitset, union each
+    // run with the overlapping runs of the previous row, then flatten.
+    void label_regions() {
+        runs_.clear();
+        run_offsets_.assign(height_ + 1, 0);
+        for (int y = 0; y < height_; ++y) {
+            run_offsets_[y] = static_cast<int>(runs_.size());
+            int x = next_walkable(y, 0);
+            while (x >= 0) {
+                int end = next_wall(y, x);
+                runs_.push_back({ x, end, 0 });
+                x = next_walkable(y, end);
+            }
+        }
+        run_offsets_[height_] = static_cast<int>(runs_.size());
+
+        std::vector<int> parent(runs_.size());
+        for (size_t i = 0; i < parent.size(); ++i) {
+            parent[i] = static_cast<int>(i);
+        }
+        for (int y = 1; y < height_; ++y) {
+            int a = run_offsets_[y - 1], a_end = run_offsets_[y];
+            int b = run_offsets_[y], b_end = run_offsets_[y + 1];
+            while (a < a_end && b < b_end) {
+                if (runs_[a].x0 < runs_[b].x1 && runs_[b].x0 < runs_[a].x1) {
+                    int ra = find(parent, a);
+                    int rb = find(parent, b);
+                    if (ra != rb) {
+                        parent[std::max(ra, rb)] = std::min(ra, rb);
+                    }
+                }
+                if (runs_[a].x1 < runs_[b].x1) {
+                    ++a;
+                } else {
+                    ++b;
+                }
+            }
+        }
+
+        region_count_ = 0;
+        std::vector<int> label_of_root(runs_.size(), -1);
+        for (size_t i = 0; i < runs_.size(); ++i) {
+            int root = find(parent, static_cast<int>(i));
+            if (label_of_root[root] < 0) {
+                label_of_root[root] = region_count_++;
+            }
+            runs_[i].label = label_of_root[root];
+        }
+    }
+
+    // First wall x >= x in row y (width_ if the row is walkable to the end).
+    int next_wall(int y, int x) const {
+        const uint64_t* r = row(y);
+        int w = x >> 6;
+        uint64_t word = ~r[w] & (~0ULL << (x & 63));
+        while (true) {
+            if (word) {
+                return std::min((w << 6) + __builtin_ctzll(word), width_);
+            }
+            if (++w >= words_per_row_) {
+                return width_;
+            }
+            word = ~r[w];
+        }
+    }
+
+    int width_ = 0;
+    int height_ = 0;
+    int words_per_row_ = 0;
+    std::vector<uint64_t> bits_;
+    size_t walkable_count_ = 0;
+
+    std::vector<Run> runs_;         // walkable runs, row-major, sorted by x0
+    std::vector<int> run_offsets_;  // runs_ index of each row's first run
+    int region_count_ = 0;
+};
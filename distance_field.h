@@ -0,0 +1,140 @@
+// distance_field.h
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "collision_grid.h"
+
+// Walking-distance field over a CollisionGrid, precomputed once per map.
+//
+// A single multi-source BFS starts from every source (exit, waypoint, ...) at
+// once and records, for every tile, the nearest reachable source and its
+// distance (3 bytes per tile), so a lookup at the player's position is a
+// single array read.
+class DistanceField {
+public:
+    static constexpr uint16_t UNREACHABLE = 0xFFFF;
+    static constexpr int MAX_SOURCES = 255;
+
+    struct Hit {
+        int source = -1;    // index into the sources passed to build()
+        int distance = -1;  // walking distance in tiles
+    };
+
+    // Sources standing on walls (exits usually do) are snapped to the nearest
+    // walkable tile first. Sources past MAX_SOURCES are ignored.
+    void build(const CollisionGrid& grid, const std::vector<CollisionGrid::Point>& sources) {
+        width_ = grid.width();
+        height_ = grid.height();
+        size_t cells = static_cast<size_t>(width_) * height_;
+
+        sources_.clear();
+        for (const auto& s : sources) {
+            if (sources_.size() >= MAX_SOURCES) {
+                break;
+            }
+            sources_.push_back(grid.nearest_walkable(s.x, s.y));
+        }
+
+        nearest_dist_.assign(cells, UNREACHABLE);
+        nearest_source_.assign(cells, 0);
+
+        // Seed every source at distance 0; when two snap to the same tile the
+        // first one keeps it
+        std::vector<int> queue;
+        for (size_t i = 0; i < sources_.size(); ++i) {
+            const auto& s = sources_[i];
+            if (!grid.walkable(s.x, s.y)) {
+                continue;
+            }
+            int c = s.y * width_ + s.x;
+            if (nearest_dist_[c] == UNREACHABLE) {
+                nearest_dist_[c] = 0;
+                nearest_source_[c] = static_cast<uint8_t>(i);
+                queue.push_back(c);
+            }
+        }
+
+        // Each tile is claimed by whichever source's wave reaches it first
+        for (size_t head = 0; head < queue.size(); ++head) {
+            int c = queue[head];
+            int x = c % width_;
+            int y = c / width_;
+            uint16_t d = nearest_dist_[c];
+            if (d + 1 >= UNREACHABLE) {
+                continue;
+            }
+            const int nx[4] = { x - 1, x + 1, x, x };
+            const int ny[4] = { y, y, y - 1, y + 1 };
+            for (int k = 0; k < 4; ++k) {
+                if (!grid.walkable(nx[k], ny[k])) {
+                    continue;
+                }
+                int n = ny[k] * width_ + nx[k];
+                if (nearest_dist_[n] == UNREACHABLE) {
+                    nearest_dist_[n] = d + 1;
+                    nearest_source_[n] = nearest_source_[c];
+                    queue.push_back(n);
+                }
+            }
+        }
+
+        // The player's tile can read as a wall (doorways, wall edges). Give
+        // walls that touch a walkable tile the best value among those
+        // neighbours, so lookups there still hit. Only walkable cells are
+        // read, so the result doesn't depend on the scan order.
+        for (int y = 0; y < height_; ++y) {
+            for (int x = 0; x < width_; ++x) {
+                if (grid.walkable(x, y)) {
+                    continue;
+                }
+                size_t c = static_cast<size_t>(y) * width_ + x;
+                for (int dy = -1; dy <= 1; ++dy) {
+                    for (int dx = -1; dx <= 1; ++dx) {
+                        if (!grid.walkable(x + dx, y + dy)) {
+                            continue;
+                        }
+                        size_t n = static_cast<size_t>(y + dy) * width_ + (x + dx);
+                        if (nearest_dist_[n] != UNREACHABLE && nearest_dist_[n] + 1 < nearest_dist_[c]) {
+                            nearest_dist_[c] = nearest_dist_[n] + 1;
+                            nearest_source_[c] = nearest_source_[n];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // Nearest reachable source from (x, y), or source == -1 if none is
+    // reachable or (x, y) is a wall away from any walkable tile.
+    Hit nearest(int x, int y) const {
+        Hit hit;
+        if (x < 0 || y < 0 || x >= width_ || y >= height_) {
+            return hit;
+        }
+        size_t c = static_cast<size_t>(y) * width_ + x;
+        if (nearest_dist_[c] == UNREACHABLE) {
+            return hit;
+        }
+        hit.source = nearest_source_[c];
+        hit.distance = nearest_dist_[c];
+        return hit;
+    }
+
+    // Walkable tile a source was snapped to, or {-1, -1}.
+    CollisionGrid::Point source_tile(int source) const {
+        if (source < 0 || source >= static_cast<int>(sources_.size())) {
+            return {};
+        }
+        return sources_[source];
+    }
+
+private:
+    int width_ = 0;
+    int height_ = 0;
+    std::vector<CollisionGrid::Point> sources_;
+    std::vector<uint16_t> nearest_dist_;    // distance to the nearest source, row-major
+    std::vector<uint8_t> nearest_source_;   // index of that source
+};
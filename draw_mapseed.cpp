@@ -3,6 +3,10 @@
 #include <string>
 #include <vector>
 #include <cstring>
+#include <cstdlib>
+#include <atomic>
+#include <memory>
+#include <thread>
 
 #include <GL/glew.h>
 #include <GL/glx.h>
@@ -12,22 +16,24 @@
 #include <X11/extensions/shape.h>
 #include <nlohmann/json.hpp>
 
+#include "map_level.h"
+#include "orchestrator.h"
+
 using json = nlohmann::json;
 
 // Global variables
-std::vector<std::vector<int>> map_data_rows;
-std::vector<json> objects;  // To store map objects (NPCs, waypoints, etc.)
-int map_width = 0;
-int map_height = 0;
+std::shared_ptr<MapLevel> current_map;  // Swapped in by the loader, read by the render loop
+std::atomic<int> player_world_x(0);     // Player position in world coordinates
+std::atomic<int> player_world_y(0);
 int window_width = 2560;
 int window_height = 1440;
 
 // Function prototypes
 json load_map_data(const std::string& file_path);
-void parse_map_data(const json& map_level);
-void renderScene(Display* display, Window window);
-void draw_objects();
-void reshape(int width, int height);
+void renderScene(Display* display, Window window, const MapLevel& map);
+void draw_objects(const MapLevel& map);
+void draw_nearest_hint(const MapLevel& map);
+void reshape(int width, int height, const MapLevel* map);
 void init_opengl();
 void make_window_click_through(Display* display, Window window);
 void make_window_transparent(Display* display, Window window);
@@ -36,27 +42,41 @@ void set_window_properties(Display* display, Window window);
 
 // Main function
 int main(int argc, char** argv) {
-    if (argc != 4) {
-        std::cerr << "Usage: ./draw_mapseed /path/to/map_data.json" << std::endl;
+    bool resident = argc == 3 && std::strcmp(argv[1], "--config") == 0;
+    if (argc != 4 && !resident) {
+        std::cerr << "Usage: ./draw_mapseed /path/to/map_data.json <player x> <player y>" << std::endl;
+        std::cerr << "       ./draw_mapseed --config memgoblin.conf" << std::endl;
         exit(1);
     }
 
-    // Load the map data from JSON
-    std::string file_path = argv[1];
-    json map_data_json = load_map_data(file_path);
-
-    bool map_found = false;
-    for (const auto& level : map_data_json["levels"]) {
-        if (level.contains("type") && level["type"] == "map") {
-            parse_map_data(level);
-            map_found = true;
-            break;
+    std::unique_ptr<Orchestrator> orchestrator;
+    std::thread precompute;
+    if (resident) {
+        // Follow the game: maps are fetched and swapped in as the player changes zones
+        OrchestratorConfig config;
+        if (!load_orchestrator_config(argv[2], config)) {
+            exit(1);
         }
-    }
+        orchestrator.reset(new Orchestrator(config,
+            [](std::shared_ptr<MapLevel> level) { std::atomic_store(&current_map, level); },
+            [](int x, int y) {
+                player_world_x.store(x, std::memory_order_relaxed);
+                player_world_y.store(y, std::memory_order_relaxed);
+            }));
+        orchestrator->start();
+    } else {
+        // Load the map data from JSON
+        std::string file_path = argv[1];
+        std::shared_ptr<MapLevel> level = parse_map_level(load_map_data(file_path));
+        if (!level) {
+            exit(1);
+        }
+        std::atomic_store(&current_map, level);
+        player_world_x = std::atoi(argv[2]);
+        player_world_y = std::atoi(argv[3]);
 
-    if (!map_found) {
-        std::cerr << "No 'map' type found in the provided JSON data." << std::endl;
-        exit(1);
+        // Precompute walking distances in the background so the window comes up right away
+        precompute = start_precompute(level);
     }
 
     // Set up X11 and GLX
@@ -139,27 +159,49 @@ int main(int argc, char** argv) {
 
     // Main event loop
     bool running = true;
+    std::shared_ptr<MapLevel> map;
     while (running) {
+        // Pick up a map swapped in since the last frame; the projection depends on its size
+        std::shared_ptr<MapLevel> latest = std::atomic_load(&current_map);
+        if (latest != map) {
+            map = latest;
+            reshape(window_width, window_height, map.get());
+        }
+
         while (XPending(display)) {
             XEvent xev;
             XNextEvent(display, &xev);
 
             if (xev.type == Expose) {
-                renderScene(display, window);  // Pass display and window here
+                if (map) {
+                    renderScene(display, window, *map);  // Pass display and window here
+                }
                 glXSwapBuffers(display, window);
             } else if (xev.type == ConfigureNotify) {
-                reshape(xev.xconfigure.width, xev.xconfigure.height);
+                window_width = xev.xconfigure.width;
+                window_height = xev.xconfigure.height;
+                reshape(window_width, window_height, map.get());
             } else if (xev.type == KeyPress) {
                 running = false;
             }
         }
 
         // Render the scene and swap buffers
-        renderScene(display, window);  // Pass display and window here
+        if (map) {
+            renderScene(display, window, *map);  // Pass display and window here
+        } else {
+            glClear(GL_COLOR_BUFFER_BIT);  // Stay transparent until the first map arrives
+        }
         glXSwapBuffers(display, window);
     }
 
     // Clean up
+    if (orchestrator) {
+        orchestrator->stop();
+    }
+    if (precompute.joinable()) {
+        precompute.join();
+    }
     glXMakeCurrent(display, None, NULL);
     glXDestroyContext(display, glc);
     XDestroyWindow(display, window);
@@ -185,33 +227,6 @@ json load_map_data(const std::string& file_path) {
     return data;
 }
 
-void parse_map_data(const json& map_level) {
-    if (map_level.find("map") == map_level.end()) {
-        std::cerr << "No 'map' key found in the map level." << std::endl;
-        exit(1);
-    }
-
-    // Extract the map data
-    map_data_rows = map_level["map"].get<std::vector<std::vector<int>>>();
-
-    // Extract objects (NPCs, waypoints, etc.)
-    if (map_level.contains("objects")) {
-        objects = map_level["objects"].get<std::vector<json>>();
-    }
-
-    // Determine map dimensions
-    map_height = map_data_rows.size();
-    for (const auto& row : map_data_rows) {
-        int sum = 0;
-        for (int val : row) {
-            sum += val;
-        }
-        if (sum > map_width) {
-            map_width = sum;
-        }
-    }
-}
-
 // OpenGL initialization for transparency and blending
 void init_opengl() {
     glEnable(GL_BLEND);
@@ -221,7 +236,7 @@ void init_opengl() {
 }
 
 // Rendering the map with black walls and white interiors
-void renderScene(Display* display, Window window) {
+void renderScene(Display* display, Window window, const MapLevel& map) {
     // Clear the screen with a transparent background
     glClearColor(0, 0, 0, 0);  // Ensure clear color is fully transparent
     glClear(GL_COLOR_BUFFER_BIT);
@@ -233,13 +248,13 @@ void renderScene(Display* display, Window window) {
 
     // Rotate around the center of the map
     glRotatef(45.0f, 0.0f, 0.0f, 1.0f);
-    int movemapx = map_width / 2;
-    int movemapy = map_height / 2;
+    int movemapx = map.width / 2;
+    int movemapy = map.height / 2;
     glTranslatef(-movemapx, -movemapy, 0.0f);
 
     // Now draw the map
-    for (int y = 0; y < map_height; ++y) {
-        const std::vector<int>& row = map_data_rows[y];
+    for (int y = 0; y < map.height; ++y) {
+        const std::vector<int>& row = map.rows[y];
         int x = 0;
         bool fill = true;
 
@@ -265,7 +280,8 @@ void renderScene(Display* display, Window window) {
     }
 
     // Draw objects on top of the map (if needed)
-    draw_objects();
+    draw_objects(map);
+    draw_nearest_hint(map);
 
     glPopMatrix();  // Restore the matrix state
 
@@ -276,8 +292,13 @@ void renderScene(Display* display, Window window) {
 
 
 
-void reshape(int width, int height) {
+void reshape(int width, int height, const MapLevel* map) {
     glViewport(0, 0, width, height);
+    if (!map) {
+        return;  // Nothing loaded yet; the projection is set once a map arrives
+    }
+    int map_width = map->width;
+    int map_height = map->height;
 
     glMatrixMode(GL_PROJECTION);
     glLoadIdentity();
@@ -301,14 +322,14 @@ void reshape(int width, int height) {
 
 
 
-void draw_objects() {
+void draw_objects(const MapLevel& map) {
     // Coordinates to track specific objects
     int op_x = -1, op_y = -1;
     int id_x = -1, id_y = -1;
     int fallback_x = -1, fallback_y = -1; // Fallback for yellow exits
     int red_x = -1, red_y = -1; // Red exit coordinates
 
-    for (const auto& object : objects) {
+    for (const auto& object : map.objects) {
         int x = object["x"];
         int y = object["y"];
 
@@ -413,6 +434,38 @@ void draw_objects() {
 }
 
 
+// Line from the player to the nearest exit or waypoint by walking distance
+void draw_nearest_hint(const MapLevel& map) {
+    if (!map.distance_field_ready.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    // Player position relative to the level
+    int player_x = player_world_x.load(std::memory_order_relaxed) - map.offset_x;
+    int player_y = player_world_y.load(std::memory_order_relaxed) - map.offset_y;
+
+    DistanceField::Hit hit = map.distance_field.nearest(player_x, player_y);
+    if (hit.source < 0) {
+        return;
+    }
+    int target_x = map.hint_targets[hit.source].x;
+    int target_y = map.hint_targets[hit.source].y;
+
+    // Player marker
+    glColor4f(1.0f, 0.0f, 1.0f, 0.7f);  // Magenta for the player, 70% opaque
+    glBegin(GL_QUADS);
+    glVertex2i(player_x - 3, player_y - 3);
+    glVertex2i(player_x + 3, player_y - 3);
+    glVertex2i(player_x + 3, player_y + 3);
+    glVertex2i(player_x - 3, player_y + 3);
+    glEnd();
+
+    glColor4f(0.0f, 1.0f, 1.0f, 0.7f);  // Cyan for the hint, 70% opaque
+    glBegin(GL_LINES);
+    glVertex2i(player_x, player_y);
+    glVertex2i(target_x, target_y);
+    glEnd();
+}
 
 
 // Window utilities
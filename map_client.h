@@ -0,0 +1,303 @@
+// map_client.h
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <strings.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Minimal HTTP/1.1 client for the map server (blacha/diablo2). Keeps one
+// connection open across requests and reconnects when the server drops it.
+// The socket is non-blocking and every wait polls in short steps, so a dead
+// server costs at most the timeouts below and clearing `running` aborts a
+// request within POLL_STEP_MS.
+class MapClient {
+public:
+    static constexpr int CONNECT_TIMEOUT_MS = 2000;
+    static constexpr int IO_TIMEOUT_MS = 10000;  // Max silence while sending or receiving
+    static constexpr int POLL_STEP_MS = 100;
+
+    MapClient(const std::string& host, const std::string& port, const std::atomic<bool>& running)
+        : host_(host), port_(port), running_(running) {}
+
+    ~MapClient() { disconnect(); }
+
+    MapClient(const MapClient&) = delete;
+    MapClient& operator=(const MapClient&) = delete;
+
+    // GET /v1/map/<seed>/<difficulty>/<act>/<area>.json into body
+    bool fetch_map(unsigned long seed, int difficulty, int act, int area_id, std::string& body) {
+        std::string path = "/v1/map/" + std::to_string(seed) + "/" + std::to_string(difficulty) + "/" +
+                           std::to_string(act) + "/" + std::to_string(area_id) + ".json";
+        return get(path, body);
+    }
+
+    bool get(const std::string& path, std::string& body) {
+        // A kept-alive connection may have been closed by the server since the
+        // last request; retry once on a fresh one before giving up.
+        bool reused = fd_ >= 0;
+        int status = request(path, body);
+        if (status < 0 && reused && running_) {
+            disconnect();
+            status = request(path, body);
+        }
+        if (status < 0) {
+            disconnect();
+            return false;
+        }
+        if (status != 200) {
+            std::cerr << "Map server returned HTTP " << status << " for " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    // HTTP status of the response, or -1 if the connection failed
+    int request(const std::string& path, std::string& body) {
+        if (fd_ < 0 && !connect_to_server()) {
+            return -1;
+        }
+
+        std::string req = "GET " + path + " HTTP/1.1\r\n"
+                          "Host: " + host_ + ":" + port_ + "\r\n"
+                          "Connection: keep-alive\r\n"
+                          "\r\n";
+        if (!send_all(req)) {
+            return -1;
+        }
+
+        // Status line and headers
+        std::string line;
+        if (!read_line(line)) {
+            return -1;
+        }
+        size_t sp = line.find(' ');
+        if (line.compare(0, 5, "HTTP/") != 0 || sp == std::string::npos) {
+            std::cerr << "Malformed response from map server: " << line << std::endl;
+            return -1;
+        }
+        int status = std::atoi(line.c_str() + sp + 1);
+
+        long content_length = -1;
+        bool chunked = false;
+        bool close_after = false;
+        while (true) {
+            if (!read_line(line)) {
+                return -1;
+            }
+            if (line.empty()) {
+                break;
+            }
+            size_t colon = line.find(':');
+            if (colon == std::string::npos) {
+                continue;
+            }
+            std::string name = line.substr(0, colon);
+            size_t start = line.find_first_not_of(' ', colon + 1);
+            std::string value = start == std::string::npos ? "" : line.substr(start);
+            if (strcasecmp(name.c_str(), "Content-Length") == 0) {
+                content_length = std::atol(value.c_str());
+            } else if (strcasecmp(name.c_str(), "Transfer-Encoding") == 0) {
+                chunked = strcasestr(value.c_str(), "chunked") != nullptr;
+            } else if (strcasecmp(name.c_str(), "Connection") == 0) {
+                close_after = strcasestr(value.c_str(), "close") != nullptr;
+            }
+        }
+
+        // Body
+        body.clear();
+        if (chunked) {
+            while (true) {
+                if (!read_line(line)) {
+                    return -1;
+                }
+                long size = std::strtol(line.c_str(), nullptr, 16);
+                if (size <= 0) {
+                    // Skip trailers up to the terminating blank line
+                    do {
+                        if (!read_line(line)) {
+                            return -1;
+                        }
+                    } while (!line.empty());
+                    break;
+                }
+                if (!read_bytes(size, body) || !read_line(line)) {
+                    return -1;
+                }
+            }
+        } else if (content_length >= 0) {
+            if (!read_bytes(content_length, body)) {
+                return -1;
+            }
+        } else {
+            // No framing: body runs until the server closes the connection
+            bool closed = false;
+            while (fill_buffer(&closed)) {
+            }
+            if (!closed) {
+                return -1;
+            }
+            body.swap(buffer_);
+            close_after = true;
+        }
+
+        if (close_after) {
+            disconnect();
+        }
+        return status;
+    }
+
+    bool connect_to_server() {
+        addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* result = nullptr;
+        int rc = getaddrinfo(host_.c_str(), port_.c_str(), &hints, &result);
+        if (rc != 0) {
+            std::cerr << "Failed to resolve map server " << host_ << ": " << gai_strerror(rc) << std::endl;
+            return false;
+        }
+
+        for (addrinfo* ai = result; ai; ai = ai->ai_next) {
+            // CLOEXEC so reader processes (and a daemonized wineserver) don't
+            // inherit the connection
+            int fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+            if (fd < 0) {
+                continue;
+            }
+            fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+            fd_ = fd;
+            bool connected = connect(fd, ai->ai_addr, ai->ai_addrlen) == 0;
+            if (!connected && errno == EINPROGRESS && wait_for(POLLOUT, CONNECT_TIMEOUT_MS)) {
+                int error = 0;
+                socklen_t len = sizeof(error);
+                connected = getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &len) == 0 && error == 0;
+            }
+            if (connected) {
+                int one = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                break;
+            }
+            close(fd);
+            fd_ = -1;
+        }
+        freeaddrinfo(result);
+
+        if (fd_ < 0) {
+            if (!running_) {
+                return false;
+            }
+            std::cerr << "Failed to connect to map server " << host_ << ":" << port_ << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    void disconnect() {
+        if (fd_ >= 0) {
+            close(fd_);
+            fd_ = -1;
+        }
+        buffer_.clear();
+    }
+
+    // Wait until fd_ is ready for events; false on timeout, error or stop
+    bool wait_for(short events, int timeout_ms) {
+        for (int waited = 0; running_ && waited < timeout_ms; waited += POLL_STEP_MS) {
+            pollfd pfd = { fd_, events, 0 };
+            int ready = poll(&pfd, 1, POLL_STEP_MS);
+            if (ready < 0 && errno != EINTR) {
+                return false;
+            }
+            if (ready > 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool send_all(const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = send(fd_, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && (errno == EINTR || errno == EAGAIN || errno == EWOULDBLOCK)) {
+                if (errno != EINTR && !wait_for(POLLOUT, IO_TIMEOUT_MS)) {
+                    return false;
+                }
+                continue;
+            }
+            if (n <= 0) {
+                return false;
+            }
+            sent += n;
+        }
+        return true;
+    }
+
+    // Append whatever arrives next to buffer_. Sets *closed when the server
+    // closed the connection cleanly.
+    bool fill_buffer(bool* closed = nullptr) {
+        char chunk[16384];
+        while (true) {
+            ssize_t n = recv(fd_, chunk, sizeof(chunk), 0);
+            if (n > 0) {
+                buffer_.append(chunk, n);
+                return true;
+            }
+            if (n == 0) {
+                if (closed) {
+                    *closed = true;
+                }
+                return false;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            if ((errno != EAGAIN && errno != EWOULDBLOCK) || !wait_for(POLLIN, IO_TIMEOUT_MS)) {
+                return false;
+            }
+        }
+    }
+
+    // One CRLF-terminated line, without the terminator
+    bool read_line(std::string& line) {
+        size_t eol;
+        while ((eol = buffer_.find("\r\n")) == std::string::npos) {
+            if (!fill_buffer()) {
+                return false;
+            }
+        }
+        line = buffer_.substr(0, eol);
+        buffer_.erase(0, eol + 2);
+        return true;
+    }
+
+    bool read_bytes(size_t count, std::string& out) {
+        while (buffer_.size() < count) {
+            if (!fill_buffer()) {
+                return false;
+            }
+        }
+        out.append(buffer_, 0, count);
+        buffer_.erase(0, count);
+        return true;
+    }
+
+    std::string host_;
+    std::string port_;
+    const std::atomic<bool>& running_;  // Owner's run flag; cleared to abort
+    int fd_ = -1;
+    std::string buffer_;  // Received but not yet consumed bytes
+};
@@ -0,0 +1,92 @@
+// map_level.h
+#pragma once
+
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "collision_grid.h"
+#include "distance_field.h"
+
+// One level as returned by the map server plus everything derived from it.
+// The overlay holds it through a shared_ptr and swaps the whole thing on a
+// zone change, so the render loop never sees a half-loaded map.
+struct MapLevel {
+    std::vector<std::vector<int>> rows;       // Run lengths, wall first
+    std::vector<nlohmann::json> objects;      // NPCs, waypoints, exits, ...
+    CollisionGrid grid;                       // Packed walkability bitset built from rows
+    int width = 0;
+    int height = 0;
+    int offset_x = 0;                         // World coordinates of the level's top-left tile
+    int offset_y = 0;
+    std::vector<CollisionGrid::Point> hint_targets;  // Exits and waypoints, in object order
+    DistanceField distance_field;                    // Walking distances to hint_targets
+    std::atomic<bool> distance_field_ready{false};   // Set once the precompute is done
+};
+
+// Build a MapLevel from a map server response. Returns nullptr (after
+// printing why) if the response holds no usable "map" level.
+inline std::shared_ptr<MapLevel> parse_map_level(const nlohmann::json& map_data) {
+    if (!map_data.contains("levels")) {
+        std::cerr << "No 'levels' key found in the map data." << std::endl;
+        return nullptr;
+    }
+
+    for (const auto& map_level : map_data["levels"]) {
+        if (!map_level.contains("type") || map_level["type"] != "map") {
+            continue;
+        }
+        if (map_level.find("map") == map_level.end()) {
+            std::cerr << "No 'map' key found in the map level." << std::endl;
+            return nullptr;
+        }
+
+        auto level = std::make_shared<MapLevel>();
+        try {
+            level->rows = map_level["map"].get<std::vector<std::vector<int>>>();
+
+            if (map_level.contains("objects")) {
+                level->objects = map_level["objects"].get<std::vector<nlohmann::json>>();
+            }
+
+            if (map_level.contains("offset")) {
+                level->offset_x = map_level["offset"].value("x", 0);
+                level->offset_y = map_level["offset"].value("y", 0);
+            }
+
+            // Exits and waypoints are the targets for the nearest-by-walking hint
+            for (const auto& object : level->objects) {
+                bool waypoint = object.contains("op") && object["op"] == 23;
+                bool is_exit = object.contains("type") && object["type"] == "exit";
+                if (waypoint || is_exit) {
+                    level->hint_targets.push_back({ object["x"].get<int>(), object["y"].get<int>() });
+                }
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Malformed map level: " << e.what() << std::endl;
+            return nullptr;
+        }
+
+        // Build the collision grid once; it also determines the map dimensions
+        level->grid.build(level->rows);
+        level->width = level->grid.width();
+        level->height = level->grid.height();
+        return level;
+    }
+
+    std::cerr << "No 'map' type found in the provided JSON data." << std::endl;
+    return nullptr;
+}
+
+// Compute the level's distance fields on a new thread. The thread holds its
+// own reference, so the level stays alive even if it is swapped out meanwhile.
+inline std::thread start_precompute(std::shared_ptr<MapLevel> level) {
+    return std::thread([level] {
+        level->distance_field.build(level->grid, level->hint_targets);
+        level->distance_field_ready.store(true, std::memory_order_release);
+    });
+}
@@ -0,0 +1,443 @@
+// orchestrator.h
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <nlohmann/json.hpp>
+
+#include "map_client.h"
+#include "map_level.h"
+
+// Act (0-4) an area id belongs to
+inline int area_act(int area_id) {
+    if (area_id < 40) {
+        return 0;
+    } else if (area_id < 75) {
+        return 1;
+    } else if (area_id < 103) {
+        return 2;
+    } else if (area_id < 109) {
+        return 3;
+    }
+    return 4;
+}
+
+// Settings read from memgoblin.conf
+struct OrchestratorConfig {
+    std::string wine = "wine";           // Launcher the reader runs under
+    std::string wineprefix;              // WINEPREFIX, left unset if empty
+    std::string reader = "memgoblin.exe";
+    std::string map_host = "127.0.0.1";  // Map server (blacha/diablo2)
+    std::string map_port = "8899";
+    int difficulty = 1;                  // [0: Normal, 1: Nightmare, 2: Hell]
+    int poll_interval_ms = 500;          // Delay before restarting the reader once it exits
+    bool verbose = false;                // Log each map fetch and pass the reader's stderr through
+};
+
+// Parse "key = value" lines; '#' starts a comment. Unknown keys are reported
+// and ignored.
+inline bool load_orchestrator_config(const std::string& file_path, OrchestratorConfig& config) {
+    std::ifstream f(file_path);
+    if (!f) {
+        std::cerr << "Failed to open config file: " << file_path << std::endl;
+        return false;
+    }
+
+    auto trim = [](const std::string& s) {
+        size_t first = s.find_first_not_of(" \t\r");
+        if (first == std::string::npos) {
+            return std::string();
+        }
+        size_t last = s.find_last_not_of(" \t\r");
+        return s.substr(first, last - first + 1);
+    };
+
+    std::string line;
+    int line_number = 0;
+    while (std::getline(f, line)) {
+        ++line_number;
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            std::cerr << file_path << ":" << line_number << ": expected key = value" << std::endl;
+            return false;
+        }
+        std::string key = trim(line.substr(0, eq));
+        std::string value = trim(line.substr(eq + 1));
+
+        if (key == "wine") {
+            config.wine = value;
+        } else if (key == "wineprefix") {
+            config.wineprefix = value;
+        } else if (key == "reader") {
+            config.reader = value;
+        } else if (key == "map_server") {
+            // host:port, optionally written as a URL
+            if (value.compare(0, 7, "http://") == 0) {
+                value = value.substr(7);
+            }
+            value = value.substr(0, value.find('/'));
+            size_t colon = value.rfind(':');
+            if (colon == std::string::npos) {
+                config.map_host = value;
+                config.map_port = "80";
+            } else {
+                config.map_host = value.substr(0, colon);
+                config.map_port = value.substr(colon + 1);
+            }
+        } else if (key == "difficulty") {
+            config.difficulty = std::atoi(value.c_str());
+        } else if (key == "poll_interval_ms") {
+            config.poll_interval_ms = std::atoi(value.c_str());
+        } else if (key == "verbose") {
+            config.verbose = value == "1" || value == "true" || value == "yes";
+        } else {
+            std::cerr << file_path << ":" << line_number << ": unknown key '" << key << "'" << std::endl;
+        }
+    }
+    return true;
+}
+
+// Replaces the memgoblin.sh pipeline: runs the memory reader, parses its
+// "seed,area,x,y" lines, fetches the level from the map server when the zone
+// changes and hands it to the overlay in memory. Levels are cached per game
+// seed together with their distance fields, so revisiting a zone is free.
+//
+// The reader thread only parses lines and forwards positions; it records the
+// wanted zone and the fetch thread loads it, so a slow map server never holds
+// up position updates.
+class Orchestrator {
+public:
+    using MapHandler = std::function<void(std::shared_ptr<MapLevel>)>;
+    using PositionHandler = std::function<void(int x, int y)>;
+
+    Orchestrator(const OrchestratorConfig& config, MapHandler on_map, PositionHandler on_position)
+        : config_(config), client_(config.map_host, config.map_port, running_),
+          on_map_(std::move(on_map)), on_position_(std::move(on_position)) {}
+
+    ~Orchestrator() { stop(); }
+
+    void start() {
+        running_ = true;
+        thread_ = std::thread(&Orchestrator::run, this);
+        fetch_thread_ = std::thread(&Orchestrator::fetch_loop, this);
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+        wanted_changed_.notify_all();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+        if (fetch_thread_.joinable()) {
+            fetch_thread_.join();
+        }
+        for (auto& precompute : precomputes_) {
+            precompute.first.join();
+        }
+        precomputes_.clear();
+    }
+
+private:
+    void run() {
+        while (running_) {
+            int fd = -1;
+            pid_t pid = spawn_reader(fd);
+            if (pid > 0) {
+                read_lines(fd);
+                close(fd);
+                int status = 0;
+                if (running_) {
+                    waitpid(pid, &status, 0);
+                    report_reader_status(status);
+                } else {
+                    kill(pid, SIGTERM);
+                    waitpid(pid, &status, 0);
+                }
+            }
+            // A one-shot reader exits after each sample; pace the restarts
+            for (int waited = 0; running_ && waited < config_.poll_interval_ms; waited += 50) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            }
+        }
+    }
+
+    // Log reader failures the first time they happen and whenever the
+    // failure changes, instead of on every restart
+    void report_reader_status(int status) {
+        if (status == last_reader_status_) {
+            return;
+        }
+        last_reader_status_ = status;
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 127) {
+            std::cerr << "Failed to run the reader: '" << config_.wine << " " << config_.reader
+                      << "' (exit 127, check the wine and reader paths in the config)" << std::endl;
+        } else if (WIFEXITED(status) && WEXITSTATUS(status) != 0) {
+            std::cerr << "Reader exited with status " << WEXITSTATUS(status) << std::endl;
+        } else if (WIFSIGNALED(status)) {
+            std::cerr << "Reader killed by signal " << WTERMSIG(status) << std::endl;
+        }
+    }
+
+    // Start the reader under wine with its stdout on a pipe
+    pid_t spawn_reader(int& read_fd) {
+        // Everything the child needs is prepared before fork(); other threads
+        // may hold the allocator lock at that point
+        std::vector<std::string> env_strings = { "WINEDEBUG=-all", "WINEFSYNC=1" };
+        if (!config_.wineprefix.empty()) {
+            env_strings.push_back("WINEPREFIX=" + config_.wineprefix);
+        }
+        for (char** e = environ; *e; ++e) {
+            std::string var = *e;
+            std::string name = var.substr(0, var.find('='));
+            if (name != "WINEDEBUG" && name != "WINEFSYNC" && (name != "WINEPREFIX" || config_.wineprefix.empty())) {
+                env_strings.push_back(var);
+            }
+        }
+        std::vector<char*> envp;
+        for (auto& var : env_strings) {
+            envp.push_back(&var[0]);
+        }
+        envp.push_back(nullptr);
+        char* argv[] = { &config_.wine[0], &config_.reader[0], nullptr };
+        bool verbose = config_.verbose;
+
+        // CLOEXEC keeps the read end out of the child; dup2 clears the flag on
+        // the stdout copy of the write end
+        int fds[2];
+        if (pipe2(fds, O_CLOEXEC) != 0) {
+            std::cerr << "Failed to create pipe for the reader." << std::endl;
+            return -1;
+        }
+
+        pid_t pid = fork();
+        if (pid < 0) {
+            std::cerr << "Failed to start the reader." << std::endl;
+            close(fds[0]);
+            close(fds[1]);
+            return -1;
+        }
+        if (pid == 0) {
+            dup2(fds[1], STDOUT_FILENO);
+            if (!verbose) {
+                int devnull = open("/dev/null", O_WRONLY);
+                if (devnull >= 0) {
+                    dup2(devnull, STDERR_FILENO);
+                    close(devnull);
+                }
+            }
+            close(fds[0]);
+            close(fds[1]);
+            execvpe(argv[0], argv, envp.data());
+            _exit(127);
+        }
+
+        close(fds[1]);
+        read_fd = fds[0];
+        return pid;
+    }
+
+    void read_lines(int fd) {
+        std::string pending;
+        char chunk[4096];
+        while (running_) {
+            pollfd pfd = { fd, POLLIN, 0 };
+            int ready = poll(&pfd, 1, 100);
+            if (ready < 0 && errno != EINTR) {
+                return;
+            }
+            if (ready <= 0) {
+                continue;
+            }
+            ssize_t n = read(fd, chunk, sizeof(chunk));
+            if (n <= 0) {
+                break;
+            }
+            pending.append(chunk, n);
+            size_t eol;
+            while ((eol = pending.find('\n')) != std::string::npos) {
+                handle_line(pending.substr(0, eol));
+                pending.erase(0, eol + 1);
+            }
+        }
+        if (running_ && !pending.empty()) {
+            handle_line(pending);
+        }
+    }
+
+    // "seed,area,x,y"; like the old `tr -cd '[:digit:]'`, anything but digits
+    // in a field is ignored
+    void handle_line(const std::string& line) {
+        std::vector<unsigned long> fields;
+        std::stringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, ',')) {
+            std::string digits;
+            for (char c : field) {
+                if (std::isdigit(static_cast<unsigned char>(c))) {
+                    digits += c;
+                }
+            }
+            fields.push_back(std::strtoul(digits.c_str(), nullptr, 10));
+        }
+        if (fields.size() < 2 || fields[0] == 0 || fields[1] == 0) {
+            return;
+        }
+
+        unsigned long seed = fields[0];
+        int area_id = static_cast<int>(fields[1]);
+        if (fields.size() >= 4) {
+            on_position_(static_cast<int>(fields[2]), static_cast<int>(fields[3]));
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (seed != wanted_seed_ || area_id != wanted_area_id_) {
+            wanted_seed_ = seed;
+            wanted_area_id_ = area_id;
+            wanted_changed_.notify_one();
+        }
+    }
+
+    // Fetch thread: loads whichever zone the reader last reported
+    void fetch_loop() {
+        unsigned long seed = 0;  // Zone currently handed to the overlay
+        int area_id = -1;
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (running_) {
+            wanted_changed_.wait(lock, [&] {
+                return !running_ || wanted_seed_ != seed || wanted_area_id_ != area_id;
+            });
+            if (!running_) {
+                break;
+            }
+            unsigned long want_seed = wanted_seed_;
+            int want_area_id = wanted_area_id_;
+
+            lock.unlock();
+            bool loaded = load_zone(want_seed, want_area_id);
+            lock.lock();
+
+            if (loaded) {
+                seed = want_seed;
+                area_id = want_area_id;
+            } else {
+                // Don't hammer the map server when it is down or has no such
+                // level; retry later unless the player moves on first
+                auto retry_at = std::chrono::steady_clock::now() +
+                                std::chrono::milliseconds(std::max(config_.poll_interval_ms, 1000));
+                wanted_changed_.wait_until(lock, retry_at, [&] {
+                    return !running_ || wanted_seed_ != want_seed || wanted_area_id_ != want_area_id;
+                });
+            }
+        }
+    }
+
+    // Hand the zone to the overlay, from the cache or the map server
+    bool load_zone(unsigned long seed, int area_id) {
+        if (seed != cache_seed_) {
+            // New game, the cached levels belong to the old seed
+            cache_.clear();
+            cache_seed_ = seed;
+        }
+
+        auto cached = cache_.find(area_id);
+        if (cached != cache_.end()) {
+            on_map_(cached->second);
+            return true;
+        }
+
+        if (config_.verbose) {
+            std::cerr << "Fetching area " << area_id << " (act " << area_act(area_id) << ") for mapseed 0x"
+                      << std::hex << seed << std::dec << std::endl;
+        }
+
+        std::shared_ptr<MapLevel> level = fetch_level(seed, area_id);
+        if (!level) {
+            return false;
+        }
+
+        cache_[area_id] = level;
+        on_map_(level);
+
+        // Never wait on an earlier level's precompute here; only reap the
+        // ones that are already done
+        for (auto it = precomputes_.begin(); it != precomputes_.end();) {
+            if (it->second->distance_field_ready.load(std::memory_order_acquire)) {
+                it->first.join();
+                it = precomputes_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        precomputes_.emplace_back(start_precompute(level), level);
+        return true;
+    }
+
+    std::shared_ptr<MapLevel> fetch_level(unsigned long seed, int area_id) {
+        std::string body;
+        if (!client_.fetch_map(seed, config_.difficulty, area_act(area_id), area_id, body)) {
+            return nullptr;
+        }
+        nlohmann::json map_data;
+        try {
+            map_data = nlohmann::json::parse(body);
+        } catch (const std::exception& e) {
+            std::cerr << "Failed to parse JSON: " << e.what() << std::endl;
+            return nullptr;
+        }
+        return parse_map_level(map_data);
+    }
+
+    std::atomic<bool> running_{false};  // Declared before client_, which watches it
+
+    OrchestratorConfig config_;
+    MapClient client_;
+    MapHandler on_map_;
+    PositionHandler on_position_;
+
+    std::thread thread_;        // Runs the reader and parses its lines
+    std::thread fetch_thread_;  // Fetches and caches levels
+    int last_reader_status_ = 0;
+
+    // Zone the reader last reported, guarded by mutex_
+    std::mutex mutex_;
+    std::condition_variable wanted_changed_;
+    unsigned long wanted_seed_ = 0;
+    int wanted_area_id_ = -1;
+
+    // Owned by the fetch thread
+    unsigned long cache_seed_ = 0;
+    std::map<int, std::shared_ptr<MapLevel>> cache_;  // Levels of cache_seed_ by area id
+    // Distance field threads still (possibly) running, joined on stop()
+    std::vector<std::pair<std::thread, std::shared_ptr<MapLevel>>> precomputes_;
+};
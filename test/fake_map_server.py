@@ -0,0 +1,79 @@
+#!/usr/bin/env python3
+# Stand-in for the blacha/diablo2 map server, for testing draw_mapseed --config
+# without the real server. Serves /v1/map/<seed>/<difficulty>/<act>/<area>.json
+# with a small generated level; area 999 answers 404. Odd areas are sent
+# chunked, even ones with Content-Length. Logs every new connection, so
+# connection reuse shows up as one CONNECT line for many GETs.
+import http.server
+import json
+import sys
+
+PORT = int(sys.argv[1]) if len(sys.argv) > 1 else 18899
+
+
+def make_level(seed, area):
+    # 200x200 room with a wall splitting it, a door in the wall, one exit
+    # on each side and a waypoint
+    size = 200
+    rows = []
+    for y in range(size):
+        if y == 0 or y == size - 1:
+            rows.append([size])
+        elif y == 100:
+            door = (seed + area) % 180 + 10
+            rows.append([door, 4, size - door - 4])
+        else:
+            rows.append([1, size - 2, 1])
+    return {
+        "levels": [{
+            "type": "map",
+            "id": area,
+            "offset": {"x": 5000 + area * 10, "y": 4000},
+            "size": {"width": size, "height": size},
+            "map": rows,
+            "objects": [
+                {"type": "exit", "id": 102, "x": 100, "y": 0},
+                {"type": "exit", "id": 100, "x": 100, "y": size - 1},
+                {"type": "object", "op": 23, "x": 20, "y": 150},
+            ],
+        }]
+    }
+
+
+class Handler(http.server.BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+
+    def setup(self):
+        super().setup()
+        print("CONNECT", self.client_address, flush=True)
+
+    def do_GET(self):
+        print("GET", self.path, flush=True)
+        parts = self.path.strip("/").split("/")
+        if len(parts) != 6 or parts[:2] != ["v1", "map"] or parts[5] == "999.json":
+            self.send_response(404)
+            self.send_header("Content-Length", "0")
+            self.end_headers()
+            return
+
+        seed, area = int(parts[2]), int(parts[5].split(".")[0])
+        body = json.dumps(make_level(seed, area)).encode()
+        self.send_response(200)
+        self.send_header("Content-Type", "application/json")
+        if area % 2:
+            self.send_header("Transfer-Encoding", "chunked")
+            self.end_headers()
+            for i in range(0, len(body), 4096):
+                chunk = body[i:i + 4096]
+                self.wfile.write(b"%x\r\n" % len(chunk) + chunk + b"\r\n")
+            self.wfile.write(b"0\r\n\r\n")
+        else:
+            self.send_header("Content-Length", str(len(body)))
+            self.end_headers()
+            self.wfile.write(body)
+
+    def log_message(self, *args):
+        pass
+
+
+http.server.ThreadingHTTPServer(("127.0.0.1", PORT), Handler).serve_forever()
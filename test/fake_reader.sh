@@ -0,0 +1,10 @@
+#!/bin/bash
+# Stand-in for wine + memgoblin.exe: streams "seed,area,x,y" lines, walking
+# the player through a few zones (area 999 is one the fake server lacks)
+seed=12345
+for area in 2 3 999 2; do
+  for step in $(seq 0 40); do
+    echo "$seed,$area,$((5000 + area * 10 + 100 + step)),$((4000 + 150 - step * 2))"
+    sleep 0.05
+  done
+done